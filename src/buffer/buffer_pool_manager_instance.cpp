@@ -12,141 +12,376 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+
 #include "common/exception.h"
 #include "common/macros.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace bustub {
 
+/** Zero a page buffer. Freshly reset pages are either overwritten by disk IO or written through before
+ * being read, so the zeroes go straight to memory with non-temporal stores instead of pulling 4KB of
+ * soon-dead lines into the cache. Page::data_ is cache-line aligned, as the streaming stores require. */
+static void ZeroPageData(char *data) {
+#ifdef __SSE2__
+  auto *dst = reinterpret_cast<__m128i *>(data);
+  const __m128i zero = _mm_setzero_si128();
+  for (size_t i = 0; i < BUSTUB_PAGE_SIZE / sizeof(__m128i); ++i) {
+    _mm_stream_si128(dst + i, zero);
+  }
+  _mm_sfence();  // make the write-combined stores visible before anyone reads the page.
+#else
+  memset(data, 0, BUSTUB_PAGE_SIZE);
+#endif
+}
+
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
                                                      LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_k, log_manager) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager)
+    : pool_size_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      next_page_id_(static_cast<page_id_t>(instance_index)),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(instance_index < num_instances,
+                "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should "
+                "just be 1.");
   // we allocate a consecutive memory space for the buffer pool
   pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHashTable<page_id_t, frame_id_t>(bucket_size_);
+  page_table_capacity_ = std::max<size_t>(pool_size_ * 2, 64);
+  page_table_ = new std::atomic<frame_id_t>[page_table_capacity_];
+  for (size_t i = 0; i < page_table_capacity_; ++i) {
+    page_table_[i].store(kFrameNotFound, std::memory_order_relaxed);
+  }
+  io_state_ = new std::atomic<uint8_t>[pool_size_];
+  for (size_t i = 0; i < pool_size_; ++i) {
+    io_state_[i].store(kIoReady, std::memory_order_relaxed);
+  }
   replacer_ = new LRUKReplacer(pool_size, replacer_k);
+  // let kernel-bypass disk managers pin and register the page array once instead of per IO.
+  disk_manager_->RegisterBuffer(pages_, pool_size_ * sizeof(Page));
 
-  // Initially, every frames are recorded in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(i);
+  // Initially, every frames are recorded in the free list. Pushed in descending order so the stack
+  // hands out frame 0 first, matching the old FIFO list.
+  free_list_.reserve(pool_size_);
+  for (size_t i = pool_size_; i > 0; --i) {
+    free_list_.emplace_back(i - 1);
   }
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
   delete[] pages_;
-  delete page_table_;
+  delete[] page_table_;
+  delete[] io_state_;
   delete replacer_;
 }
 
-auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
-  std::scoped_lock<std::mutex> lock(latch_);
-  frame_id_t f_id;
-  *page_id = INVALID_PAGE_ID;
+auto BufferPoolManagerInstance::CurrentIoEpoch() -> uint64_t {
+  std::lock_guard<std::mutex> guard(cv_mutex_);
+  return io_epoch_;
+}
+
+void BufferPoolManagerInstance::WaitIoEpoch(uint64_t epoch) {
+  std::unique_lock<std::mutex> guard(cv_mutex_);
+  cv_.wait(guard, [&] { return io_epoch_ != epoch; });
+}
 
-  if (!free_list_.empty()) {    // found free frames in buffer pool.
-    f_id = free_list_.front();  // get free frame.
-    free_list_.pop_front();
-  } else if (replacer_->Evict(&f_id)) {  // or if replacer can evict one frame.
-  } else {
-    return nullptr;  // all frame are current in use and not evictable.
+void BufferPoolManagerInstance::FinishIo(frame_id_t frame_id, page_id_t flushed_page_id) {
+  if (flushed_page_id != INVALID_PAGE_ID) {
+    std::scoped_lock<std::shared_mutex> lock(latch_);
+    flushing_.erase(flushed_page_id);
   }
-  auto fm = pages_ + f_id;  // the evicted frame address.
-  if (fm->is_dirty_) {      // if the frame is dirty, flush it to the disk.
-    disk_manager_->WritePage(fm->page_id_, fm->data_);
-    fm->is_dirty_ = false;
+  {
+    std::lock_guard<std::mutex> guard(cv_mutex_);
+    io_state_[frame_id].store(kIoReady, std::memory_order_release);
+    ++io_epoch_;
   }
-  page_table_->Remove(fm->page_id_);  // unmap the original frame id and page id.
+  cv_.notify_all();
+}
 
-  page_table_->Insert(next_page_id_, f_id);  // map the page id to frame id.
+auto BufferPoolManagerInstance::FindFrame(page_id_t page_id, frame_id_t &frame_id) -> bool {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= page_table_capacity_) {
+    return false;
+  }
+  frame_id_t f_id = page_table_[page_id].load(std::memory_order_acquire);
+  if (f_id == kFrameNotFound) {
+    return false;
+  }
+  frame_id = f_id;
+  return true;
+}
 
-  *page_id = next_page_id_;  // put the new page id into the out parameter.
-  // record access history of the frame in the replacer for the lru-k algorithm to work.
-  replacer_->RecordAccess(f_id);
-  replacer_->SetEvictable(f_id, false);  // pin the frame.
-  // update the metadata of the new page.
-  fm->page_id_ = next_page_id_;
-  fm->pin_count_++;
-  memset(fm->data_, '\0', BUSTUB_PAGE_SIZE);
-  AllocatePage();  // prepare for getting next page id.
-  return pages_ + f_id;
+void BufferPoolManagerInstance::InsertFrame(page_id_t page_id, frame_id_t frame_id) {
+  if (static_cast<size_t>(page_id) >= page_table_capacity_) {
+    size_t new_capacity = page_table_capacity_;
+    while (static_cast<size_t>(page_id) >= new_capacity) {
+      new_capacity *= 2;
+    }
+    auto *new_table = new std::atomic<frame_id_t>[new_capacity];
+    size_t i = 0;
+    for (; i < page_table_capacity_; ++i) {
+      new_table[i].store(page_table_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    for (; i < new_capacity; ++i) {
+      new_table[i].store(kFrameNotFound, std::memory_order_relaxed);
+    }
+    delete[] page_table_;
+    page_table_ = new_table;
+    page_table_capacity_ = new_capacity;
+  }
+  page_table_[page_id].store(frame_id, std::memory_order_release);
 }
 
-auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
-  std::scoped_lock<std::mutex> lock(latch_);
-  frame_id_t f_id;  // index of frame which is not used.
-  if (!page_table_->Find(page_id, f_id)) {
-    if (!free_list_.empty()) {
-      f_id = free_list_.front();
-      free_list_.pop_front();
-    } else if (replacer_->Evict(&f_id)) {
+void BufferPoolManagerInstance::RemoveFrame(page_id_t page_id) {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= page_table_capacity_) {
+    return;  // e.g. the INVALID_PAGE_ID of a frame fresh off the free list.
+  }
+  page_table_[page_id].store(kFrameNotFound, std::memory_order_release);
+}
+
+void BufferPoolManagerInstance::ReplaceFrame(page_id_t old_page_id, page_id_t new_page_id, frame_id_t frame_id) {
+  if (old_page_id >= 0 && static_cast<size_t>(old_page_id) < page_table_capacity_) {
+    page_table_[old_page_id].store(kFrameNotFound, std::memory_order_release);
+  }
+  InsertFrame(new_page_id, frame_id);  // InsertFrame grows the table if new_page_id is past capacity.
+}
+
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
+  frame_id_t f_id;
+  *page_id = INVALID_PAGE_ID;
+  Page *fm;
+  page_id_t flush_page_id = INVALID_PAGE_ID;  // dirty victim to write back outside the latch, if any.
+  {
+    std::scoped_lock<std::shared_mutex> lock(latch_);
+    if (num_pinned_.load(std::memory_order_relaxed) == pool_size_) {
+      return nullptr;  // every frame is pinned: no free frame and nothing the replacer could evict.
+    }
+    if (!free_list_.empty()) {   // found free frames in buffer pool.
+      f_id = free_list_.back();  // get free frame.
+      free_list_.pop_back();
+    } else if (replacer_->Evict(&f_id)) {  // or if replacer can evict one frame.
     } else {
-      return nullptr;
+      return nullptr;  // all frame are current in use and not evictable.
     }
-    auto fm = pages_ + f_id;
-    if (fm->is_dirty_) {
-      disk_manager_->WritePage(fm->page_id_, fm->data_);
+    fm = pages_ + f_id;   // the evicted frame address.
+    if (fm->is_dirty_) {  // dirty victim: defer the write-back until after the latch is released.
+      flush_page_id = fm->page_id_;
       fm->is_dirty_ = false;
+      // fetches of the victim page must wait for the write-back or they could read stale disk bytes,
+      // and fetch hits on this frame must wait until its buffer holds the new page's (zeroed) data.
+      flushing_.insert(flush_page_id);
+      io_state_[f_id].store(kIoLoading, std::memory_order_release);
+    }
+    // remap the frame from its old page id to the new one in one table operation.
+    ReplaceFrame(fm->page_id_, next_page_id_, f_id);
+
+    *page_id = next_page_id_;  // put the new page id into the out parameter.
+    // record access history of the frame in the replacer for the lru-k algorithm to work.
+    replacer_->RecordAccess(f_id);
+    replacer_->SetEvictable(f_id, false);  // pin the frame.
+    // update the metadata of the new page.
+    fm->page_id_ = next_page_id_;
+    fm->pin_count_++;  // frames off the free list or fresh from eviction are unpinned: 0 -> 1.
+    num_pinned_.fetch_add(1, std::memory_order_relaxed);
+    AllocatePage();  // prepare for getting next page id.
+    if (flush_page_id == INVALID_PAGE_ID) {
+      // clean victim: zero under the latch so concurrent fetch hits never see the old contents.
+      ZeroPageData(fm->data_);
+      return fm;
     }
-    page_table_->Remove(fm->page_id_);
-    disk_manager_->ReadPage(page_id, fm->data_);  // read the page data from the disk and replace the old frame's data.
-    page_table_->Insert(page_id, f_id);
   }
-  // record access history of the frame in the replacer for the lru-k algorithm to work.
-  replacer_->RecordAccess(f_id);
-  replacer_->SetEvictable(f_id, false);  // pin the frame.
-  pages_[f_id].page_id_ = page_id;
-  pages_[f_id].pin_count_++;
-  return pages_ + f_id;
+  // the frame is pinned and marked loading, so the write-back can run without the latch: concurrent
+  // fetches of either page id find the mapping and wait instead of racing the IO.
+  disk_manager_->WritePage(flush_page_id, fm->data_);
+  ZeroPageData(fm->data_);
+  FinishIo(f_id, flush_page_id);
+  return fm;
 }
 
-auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
-  frame_id_t f_id;
-  if (!page_table_->Find(page_id, f_id)) {  // page is not in the buffer pool.
-    return false;
-  }
-  Page *pg = pages_ + f_id;
-  if (pg->pin_count_ <= 0) {  // page's pin count less or equal 0 before unpin.
-    return false;
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
+  while (true) {
+    // sample the completion epoch before any state check: if the IO we end up waiting for completes in
+    // between, the wait below returns immediately instead of sleeping through the wakeup.
+    uint64_t epoch = CurrentIoEpoch();
+    {
+      // fast path: the page is already resident. A shared latch keeps eviction out (evictions only
+      // happen under the exclusive latch), so concurrent hits only touch the atomic pin count and the
+      // replacer, which carries its own latch.
+      std::shared_lock<std::shared_mutex> lock(latch_);
+      frame_id_t f_id;
+      if (FindFrame(page_id, f_id)) {
+        if (io_state_[f_id].load(std::memory_order_acquire) == kIoReady) {
+          if (pages_[f_id].pin_count_.fetch_add(1) == 0) {
+            num_pinned_.fetch_add(1, std::memory_order_relaxed);
+          }
+          replacer_->RecordAccess(f_id);
+          replacer_->SetEvictable(f_id, false);  // pin the frame.
+          return pages_ + f_id;
+        }
+        // another thread claimed the frame for this page but its IO has not finished yet.
+        lock.unlock();
+        WaitIoEpoch(epoch);
+        continue;
+      }
+    }
+    frame_id_t f_id;  // index of frame which is not used.
+    Page *fm;
+    page_id_t flush_page_id = INVALID_PAGE_ID;  // dirty victim to write back outside the latch, if any.
+    {
+      std::unique_lock<std::shared_mutex> lock(latch_);
+      // re-check under the exclusive latch: another thread may have loaded the page meanwhile.
+      if (FindFrame(page_id, f_id)) {
+        if (io_state_[f_id].load(std::memory_order_acquire) != kIoReady) {
+          lock.unlock();
+          WaitIoEpoch(epoch);  // another thread claimed the frame for this page; wait its IO out.
+          continue;
+        }
+        replacer_->RecordAccess(f_id);
+        replacer_->SetEvictable(f_id, false);  // pin the frame.
+        if (pages_[f_id].pin_count_.fetch_add(1) == 0) {
+          num_pinned_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return pages_ + f_id;
+      }
+      if (flushing_.count(page_id) > 0) {
+        // the page's dirty contents are still being written back from some victim frame: reading it
+        // from disk now could return the stale bytes, so wait for that write to finish.
+        lock.unlock();
+        WaitIoEpoch(epoch);
+        continue;
+      }
+      if (num_pinned_.load(std::memory_order_relaxed) == pool_size_) {
+        return nullptr;  // every frame is pinned: no free frame and nothing the replacer could evict.
+      }
+      if (!free_list_.empty()) {
+        f_id = free_list_.back();
+        free_list_.pop_back();
+      } else if (replacer_->Evict(&f_id)) {
+      } else {
+        return nullptr;
+      }
+      fm = pages_ + f_id;
+      if (fm->is_dirty_) {  // dirty victim: defer the write-back until after the latch is released.
+        flush_page_id = fm->page_id_;
+        fm->is_dirty_ = false;
+        flushing_.insert(flush_page_id);
+      }
+      // publish the mapping and the pin before dropping the latch: concurrent fetches of this page find
+      // the frame and wait on its IO state instead of loading it a second time, and the pin keeps the
+      // loading frame out of the replacer.
+      ReplaceFrame(fm->page_id_, page_id, f_id);
+      fm->page_id_ = page_id;
+      replacer_->RecordAccess(f_id);
+      replacer_->SetEvictable(f_id, false);  // pin the frame.
+      fm->pin_count_++;                      // frames off the free list or fresh from eviction are unpinned: 0 -> 1.
+      num_pinned_.fetch_add(1, std::memory_order_relaxed);
+      io_state_[f_id].store(kIoLoading, std::memory_order_release);
+    }
+    // the disk IO itself runs without the latch, so hits on other pages proceed concurrently.
+    if (flush_page_id != INVALID_PAGE_ID) {
+      disk_manager_->WritePage(flush_page_id, fm->data_);
+    }
+    disk_manager_->ReadPage(page_id, fm->data_);  // read the page data from the disk into the frame.
+    FinishIo(f_id, flush_page_id);
+    return fm;
   }
-  if (--pg->pin_count_ == 0) {
-    replacer_->SetEvictable(f_id, true);  // if the pin count is 0, the frame should be evicted by replacer.
+}
+
+auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  int pin;
+  {
+    // fast path under the shared latch: the dirty flag is sticky and atomic, and the pin count comes
+    // down with a CAS loop so a racing unpin can never push it below zero.
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    frame_id_t f_id;
+    if (!FindFrame(page_id, f_id)) {  // page is not in the buffer pool.
+      return false;
+    }
+    Page *pg = pages_ + f_id;
+    pin = pg->pin_count_.load(std::memory_order_relaxed);
+    do {
+      if (pin <= 0) {  // page's pin count less or equal 0 before unpin.
+        return false;
+      }
+    } while (!pg->pin_count_.compare_exchange_weak(pin, pin - 1, std::memory_order_acq_rel));
+    if (is_dirty) {
+      pg->is_dirty_.store(true, std::memory_order_release);
+    }
+    if (pin > 1) {  // still pinned by someone else: nothing more to do.
+      return true;
+    }
+    num_pinned_.fetch_sub(1, std::memory_order_relaxed);  // this unpin took the frame to 0.
   }
-  if (!pg->is_dirty_) {
-    pg->is_dirty_ = is_dirty;
+  // the pin count reached 0: flip evictability under the exclusive latch, re-checking the count in case
+  // a fetch re-pinned the frame in between — otherwise that late SetEvictable(true) could expose a
+  // pinned frame to eviction.
+  std::scoped_lock<std::shared_mutex> lock(latch_);
+  frame_id_t f_id;
+  if (FindFrame(page_id, f_id) && pages_[f_id].pin_count_.load(std::memory_order_acquire) == 0) {
+    replacer_->SetEvictable(f_id, true);
   }
   return true;
 }
 
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
   BUSTUB_ASSERT(page_id >= 0, "INVALID_PAGE_ID");
-  frame_id_t f_id;
-  if (!page_table_->Find(page_id, f_id)) {
-    return false;
+  while (true) {
+    uint64_t epoch = CurrentIoEpoch();
+    std::unique_lock<std::shared_mutex> lock(latch_);
+    frame_id_t f_id;
+    if (!FindFrame(page_id, f_id)) {
+      return false;
+    }
+    if (io_state_[f_id].load(std::memory_order_acquire) != kIoReady) {
+      // the frame's buffer is mid-IO; flushing it now would write a half-loaded page.
+      lock.unlock();
+      WaitIoEpoch(epoch);
+      continue;
+    }
+    disk_manager_->WritePage(page_id, pages_[f_id].data_);
+    pages_[f_id].is_dirty_ = false;  // unset the dirty flag after flush.
+    return true;
   }
-  disk_manager_->WritePage(page_id, pages_[f_id].data_);
-  pages_[f_id].is_dirty_ = false;  // unset the dirty flag after flush.
-  return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  std::scoped_lock<std::mutex> lock(latch_);
+  std::scoped_lock<std::shared_mutex> lock(latch_);
+  std::vector<std::pair<page_id_t, const char *>> batch;
+  batch.reserve(pool_size_);
+  for (size_t i = 0; i < pool_size_; ++i) {
+    if (io_state_[i].load(std::memory_order_acquire) != kIoReady) {
+      continue;  // mid-IO frames are flushed (or loaded) by their owner; skip the half-filled buffer.
+    }
+    batch.emplace_back(i, pages_[i].data_);
+  }
+  disk_manager_->WritePages(batch);  // one submission; async disk managers keep the batch in flight.
   for (size_t i = 0; i < pool_size_; ++i) {
-    disk_manager_->WritePage(i, pages_[i].data_);
-    pages_[i].is_dirty_ = false;  // unset the dirty flag after flush.
+    if (io_state_[i].load(std::memory_order_acquire) == kIoReady) {
+      pages_[i].is_dirty_ = false;  // unset the dirty flag after flush.
+    }
   }
 }
 
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
+  std::scoped_lock<std::shared_mutex> lock(latch_);
   frame_id_t f_id;
-  if (!page_table_->Find(page_id, f_id)) {  // page id is not in the buffer pool.
+  if (!FindFrame(page_id, f_id)) {  // page id is not in the buffer pool.
     return true;
   }
   if (pages_[f_id].pin_count_ > 0) {  // page is pinned in buffer pool which is not be delete.
     return false;
   }
-  page_table_->Remove(page_id);
+  RemoveFrame(page_id);
   // stop tracking the frame in replacer.
   replacer_->Remove(f_id);
   // add the frame back to the free list.
@@ -155,13 +390,15 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
   pages_[f_id].is_dirty_ = false;
   pages_[f_id].pin_count_ = 0;
   pages_[f_id].page_id_ = INVALID_PAGE_ID;
-  memset(pages_[f_id].data_, '\0', BUSTUB_PAGE_SIZE);
+  ZeroPageData(pages_[f_id].data_);
   // free the page on the disk.
   DeallocatePage(page_id);
   // deletion succeed.
   return true;
 }
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t { return next_page_id_++; }
+auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
+  return next_page_id_.fetch_add(static_cast<page_id_t>(num_instances_));
+}
 
 }  // namespace bustub
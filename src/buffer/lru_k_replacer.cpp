@@ -12,127 +12,232 @@
 
 #include "buffer/lru_k_replacer.h"
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 namespace bustub {
 
+/** Shared source of timestamp blocks. Threads reserve kTimestampBatch stamps at a time, so the hot
+ * counter line is touched once per block instead of once per access. Timestamps only need to be
+ * monotonic per thread — LRU-K compares relative recency, and a bounded cross-thread skew of one block
+ * is indistinguishable from scheduling jitter. */
+static std::atomic<size_t> global_timestamp{0};
+
+auto LRUKReplacer::NextTimestamp() -> size_t {
+  struct alignas(64) TlsTimestamps {
+    size_t base{0};
+    size_t count{kTimestampBatch};  // start exhausted so the first access reserves a block.
+  };
+  thread_local TlsTimestamps tls;
+  if (tls.count == kTimestampBatch) {
+    tls.base = global_timestamp.fetch_add(kTimestampBatch, std::memory_order_relaxed);
+    tls.count = 0;
+  }
+  return tls.base + tls.count++;
+}
+
 LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {
-  // LOG_INFO("initialize LRUKReplacer(%ld, %ld)", num_frames, k);
   BUSTUB_ASSERT(k != 0, "elicit value of k!");
-  record_.assign(num_frames,
-                 std::vector<int>());       // initialize the num_frames of empty vector to record K's access.
+  hist_.assign(num_frames * k, 0);  // one k-slot ring buffer per frame, stored back to back.
+  hist_head_.assign(num_frames, 0);
+  hist_count_.assign(num_frames, 0);
   is_evictable_.assign(num_frames, false);  // initialize non-evictable;
+  scan_key_.assign(num_frames, kIneligible);
+  // one extra node serves as the sentinel of the circular history list.
+  nodes_.assign(num_frames + 1, FrameNode{});
+  sentinel_ = static_cast<frame_id_t>(num_frames);
+  nodes_[sentinel_].prev = sentinel_;  // empty list: sentinel points at itself.
+  nodes_[sentinel_].next = sentinel_;
+  for (auto &slot : pending_) {
+    slot.fid.store(kEmptySlot, std::memory_order_relaxed);
+  }
+}
+
+void LRUKReplacer::DrainPending() {
+  // close the buffer: claimers that see the cap fall back to the latch, which we are holding.
+  size_t n = pending_size_.exchange(kPendingBatch, std::memory_order_acquire);
+  for (size_t i = 0; i < n; ++i) {
+    frame_id_t frame_id;
+    do {  // a claimer may still be between its CAS and the publishing store; its slot appears shortly.
+      frame_id = pending_[i].fid.load(std::memory_order_acquire);
+    } while (frame_id == kEmptySlot);
+    RecordAccessLocked(frame_id, pending_[i].ts.load(std::memory_order_relaxed));
+    pending_[i].fid.store(kEmptySlot, std::memory_order_relaxed);
+  }
+  pending_size_.store(0, std::memory_order_release);  // reopen the buffer.
+}
+
+void LRUKReplacer::LinkFront(frame_id_t frame_id) {
+  FrameNode &node = nodes_[frame_id];
+  node.prev = sentinel_;
+  node.next = nodes_[sentinel_].next;
+  nodes_[node.next].prev = frame_id;
+  nodes_[sentinel_].next = frame_id;
+  node.in_list = true;
+}
+
+void LRUKReplacer::Unlink(frame_id_t frame_id) {
+  FrameNode &node = nodes_[frame_id];
+  nodes_[node.prev].next = node.next;
+  nodes_[node.next].prev = node.prev;
+  node.in_list = false;
+}
+
+void LRUKReplacer::UpdateScanKey(frame_id_t frame_id) {
+  if (hist_count_[frame_id] >= k_ && is_evictable_[frame_id]) {
+    // truncation to 32 bits keeps the scan stream dense; relative order holds for any realistic run.
+    scan_key_[frame_id] = static_cast<uint32_t>(KthTimestamp(frame_id));
+  } else {
+    scan_key_[frame_id] = kIneligible;
+  }
 }
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
   std::scoped_lock<std::mutex> lock(latch_);
+  DrainPending();
   frame_id_t f_id = INVALID_PAGE_ID;
-  // prior to evict the frame in lru_1_replacer_.
-  if (!lru_1_replacer_.empty()) {  // lru_1_cache_ is not empty.
-    auto ptr = lru_1_replacer_.end();
-    ptr = std::prev(ptr);
-    while (ptr != lru_1_replacer_.begin() && !is_evictable_[*ptr]) {
-      ptr = std::prev(ptr);
+  // prior to evict the frame whose access history is less than k: walk the history list from the LRU end.
+  for (frame_id_t cur = nodes_[sentinel_].prev; cur != sentinel_; cur = nodes_[cur].prev) {
+    __builtin_prefetch(&nodes_[nodes_[cur].prev]);  // the walk is a dependent pointer chase; overlap the next hop.
+    if (is_evictable_[cur]) {
+      f_id = cur;
+      Unlink(cur);
+      break;
     }
-    // check the front elements of lru_1_replacer.
-    if (!is_evictable_[*ptr]) {  // no frames can be evicted.
-      int earliest_time_stamp = INT_MAX;
-      for (size_t i = 0; i < record_.size(); ++i) {
-        size_t log_num = record_[i].size();
-        if (log_num < k_ ||
-            !is_evictable_[i]) {  // jump the frame that access history times less than k or not-evictable frame.
-          continue;
-        }
-        if (record_[i][log_num - k_] < earliest_time_stamp) {
-          earliest_time_stamp = record_[i][log_num - k_];
-          f_id = i;
+  }
+  if (f_id == INVALID_PAGE_ID) {  // no evictable frame with < k accesses: fall back to the >= k set.
+    // one sequential sweep over the dense scan keys; non-candidates carry the max sentinel and lose
+    // every comparison, so the loop needs no eligibility branches.
+    uint32_t earliest_key = kIneligible;
+    size_t i = 0;
+#ifdef __AVX2__
+    if (replacer_size_ >= 8) {
+      // track the running minimum of 8 key lanes and, in a second register, the frame index each lane's
+      // minimum came from; one horizontal reduction at the end picks the overall victim.
+      __m256i best_keys = _mm256_set1_epi32(-1);  // all lanes start at the kIneligible sentinel.
+      __m256i best_idx = _mm256_setzero_si256();
+      __m256i lane_idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+      const __m256i lane_step = _mm256_set1_epi32(8);
+      for (; i + 8 <= replacer_size_; i += 8) {
+        __m256i keys = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&scan_key_[i]));
+        __m256i mins = _mm256_min_epu32(best_keys, keys);
+        __m256i took_new = _mm256_cmpeq_epi32(mins, keys);  // lanes where the new key is the (new) minimum.
+        best_idx = _mm256_blendv_epi8(best_idx, lane_idx, took_new);
+        best_keys = mins;
+        lane_idx = _mm256_add_epi32(lane_idx, lane_step);
+      }
+      alignas(32) uint32_t keys_out[8];
+      alignas(32) uint32_t idx_out[8];
+      _mm256_store_si256(reinterpret_cast<__m256i *>(keys_out), best_keys);
+      _mm256_store_si256(reinterpret_cast<__m256i *>(idx_out), best_idx);
+      for (int lane = 0; lane < 8; ++lane) {
+        if (keys_out[lane] < earliest_key) {
+          earliest_key = keys_out[lane];
+          f_id = static_cast<frame_id_t>(idx_out[lane]);
         }
       }
-    } else {
-      f_id = *ptr;
-      lru_1_replacer_.remove(f_id);
     }
-  } else {  // >= k
-    int earliest_time_stamp = INT_MAX;
-    for (size_t i = 0; i < record_.size(); ++i) {
-      size_t log_num = record_[i].size();
-      if (log_num < k_ || !is_evictable_[i]) {
-        continue;
-      }
-      if (record_[i][log_num - k_] < earliest_time_stamp) {
-        earliest_time_stamp = record_[i][log_num - k_];
-        f_id = i;
-      }
+#endif
+    for (; i < replacer_size_; ++i) {  // scalar tail (and full sweep without AVX2).
+      // written as conditional moves rather than a branch: whether any one frame beats the running
+      // minimum is data-dependent and unpredictable, so a branch here would mispredict constantly.
+      uint32_t key = scan_key_[i];
+      bool take = key < earliest_key;
+      f_id = take ? static_cast<frame_id_t>(i) : f_id;
+      earliest_key = take ? key : earliest_key;
     }
   }
   if (f_id == INVALID_PAGE_ID) {  // no frames can be evicted.
     return false;
   }
-  record_[f_id].clear();  // remove the frame's access history.
+  hist_count_[f_id] = 0;  // remove the frame's access history.
+  hist_head_[f_id] = 0;
   is_evictable_[f_id] = false;
-  hash_.erase(f_id);
+  scan_key_[f_id] = kIneligible;
   curr_size_--;
   *frame_id = f_id;
   return true;
 }
 
 void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
-  std::scoped_lock<std::mutex> lock(latch_);
   BUSTUB_ASSERT(frame_id < (int)replacer_size_, "frame id is invalid.");
-  auto &timestamp_arr = record_[frame_id];
-  timestamp_arr.push_back(current_timestamp_);  // update elements of record array.
-  // >= k_ do nothing.
-  auto it = hash_.find(frame_id);
-  if (timestamp_arr.size() < k_) {
-    if (it == hash_.end()) {
-      lru_1_replacer_.push_front(frame_id);
-      hash_.insert({frame_id, lru_1_replacer_.begin()});
+  size_t timestamp = NextTimestamp();  // stamp on entry, before any queueing or latching.
+  while (true) {
+    size_t slot = pending_size_.load(std::memory_order_relaxed);
+    if (slot >= kPendingBatch) {  // buffer full (or a drain in progress): fall back to the latch.
+      std::scoped_lock<std::mutex> lock(latch_);
+      DrainPending();  // replay the earlier records first so the FIFO order is preserved.
+      RecordAccessLocked(frame_id, timestamp);
+      return;
+    }
+    if (pending_size_.compare_exchange_weak(slot, slot + 1, std::memory_order_acquire)) {
+      pending_[slot].ts.store(timestamp, std::memory_order_relaxed);
+      pending_[slot].fid.store(frame_id, std::memory_order_release);  // publish; a drainer waits for this.
+      return;
+    }
+  }
+}
+
+void LRUKReplacer::RecordAccessLocked(frame_id_t frame_id, size_t timestamp) {
+  uint32_t head = hist_head_[frame_id];
+  hist_[frame_id * k_ + head] = timestamp;  // overwrite the oldest slot of the ring.
+  hist_head_[frame_id] = (head + 1 == k_) ? 0 : head + 1;
+  if (hist_count_[frame_id] < k_) {
+    ++hist_count_[frame_id];
+  }
+  if (hist_count_[frame_id] < k_) {
+    if (!nodes_[frame_id].in_list) {  // first access: track it in the history list.
+      LinkFront(frame_id);
     }
-  } else {  // >= k
-    // move it from LRU-1 mode to LRU-k mode.
-    if (it != hash_.end()) {
-      hash_.erase(frame_id);
-      lru_1_replacer_.remove(frame_id);
+  } else {  // >= k: move it from LRU-1 mode to LRU-k mode.
+    if (nodes_[frame_id].in_list) {
+      Unlink(frame_id);
     }
+    UpdateScanKey(frame_id);  // the k-th-last timestamp just advanced.
   }
-  ++current_timestamp_;  // every access with incrementing time stamp.
 }
 
 void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
   std::scoped_lock<std::mutex> lock(latch_);
+  DrainPending();
   BUSTUB_ASSERT(frame_id < (int)(replacer_size_), "frame id is invalid.");
-  auto timestamp_arr = record_[frame_id];
   // teminate if the frame does not have record.
-  if (timestamp_arr.empty()) {
+  if (hist_count_[frame_id] == 0) {
     return;
   }
   bool pre_status = is_evictable_[frame_id];  // the previous evictable status of the frame.
   if (!pre_status && set_evictable) {         // non-evictable to evictable
     is_evictable_[frame_id] = set_evictable;
     curr_size_++;                             // increase the size of replacer.
+    UpdateScanKey(frame_id);
   } else if (pre_status && !set_evictable) {  // evictable to non-evictable
     is_evictable_[frame_id] = set_evictable;
     curr_size_--;
+    UpdateScanKey(frame_id);
   }
 }
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
   std::scoped_lock<std::mutex> lock(latch_);
-  auto timestamp_arr = record_[frame_id];
-  if (timestamp_arr.empty()) {  // frame is not found.
+  DrainPending();
+  if (hist_count_[frame_id] == 0) {  // frame is not found.
     return;
   }
   BUSTUB_ASSERT(is_evictable_[frame_id], "not be abled to remove non-evictable frame.");
-  if (timestamp_arr.size() < k_) {
-    lru_1_replacer_.remove(frame_id);
-    hash_.erase(frame_id);
+  if (nodes_[frame_id].in_list) {  // frames with >= k accesses are only tracked via their scan key.
+    Unlink(frame_id);
   }
-  // >= k_  do nothing.
   is_evictable_[frame_id] = false;
-  record_[frame_id].clear();  // remove the frame's access history.
+  hist_count_[frame_id] = 0;  // remove the frame's access history.
+  hist_head_[frame_id] = 0;
+  scan_key_[frame_id] = kIneligible;
   curr_size_--;
 }
 
 auto LRUKReplacer::Size() -> size_t {
   std::scoped_lock<std::mutex> lock(latch_);
+  DrainPending();
   return curr_size_;
 }
 
@@ -10,167 +10,363 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <functional>
 #include <list>
+#include <type_traits>
 #include <utility>
 
 #include "container/hash/extendible_hash_table.h"
 #include "storage/page/page.h"
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "common/macros.h"
+
 namespace bustub {
 
-template <typename K, typename V>
-ExtendibleHashTable<K, V>::ExtendibleHashTable(size_t bucket_size)
-    : global_depth_(0), bucket_size_(bucket_size), num_buckets_(1) {
-  for (int i = 0; i < num_buckets_; ++i) {
-    dir_.push_back(std::make_shared<Bucket>(bucket_size));  // add bucket(defualt depth: 0)
+template <typename K, typename V, size_t N>
+ExtendibleHashTable<K, V, N>::ExtendibleHashTable(size_t bucket_size, int max_global_depth)
+    : global_depth_(0), max_global_depth_(max_global_depth), bucket_size_(bucket_size), num_buckets_(1) {
+  BUSTUB_ASSERT(max_global_depth > 0 && max_global_depth <= kMaxGlobalDepth, "invalid maximum global depth.");
+  pool_.push_back(std::make_unique<Bucket>(bucket_size));  // add bucket(defualt depth: 0)
+  // preallocate the directory to its maximum depth; every slot starts at the single initial bucket.
+  dir_ = std::make_unique<std::atomic<Bucket *>[]>(size_t{1} << max_global_depth_);
+  for (size_t i = 0; i < (size_t{1} << max_global_depth_); ++i) {
+    dir_[i].store(pool_.back().get(), std::memory_order_relaxed);
   }
 }
 
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::IndexOf(const K &key) -> size_t {
-  int mask = (1 << global_depth_) - 1;  // get low global_depth_ bits.
-  return std::hash<K>()(key) & mask;
+template <typename K, typename V, size_t N>
+auto ExtendibleHashTable<K, V, N>::IndexOf(const K &key) -> size_t {
+  return IndexFromHash(HashOf(key));  // get low global_depth_ bits of the hash.
 }
 
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetGlobalDepth() const -> int {
-  std::scoped_lock<std::mutex> lock(latch_);
+template <typename K, typename V, size_t N>
+auto ExtendibleHashTable<K, V, N>::GetGlobalDepth() const -> int {
+  // every field the accessors touch is atomic, so none of them needs the latch: a statistics call
+  // never contends with an Insert that is mid-split.
   return GetGlobalDepthInternal();
 }
 
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetGlobalDepthInternal() const -> int {
-  return global_depth_;
+template <typename K, typename V, size_t N>
+auto ExtendibleHashTable<K, V, N>::GetGlobalDepthInternal() const -> int {
+  return global_depth_.load(std::memory_order_relaxed);
 }
 
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetLocalDepth(int dir_index) const -> int {
-  std::scoped_lock<std::mutex> lock(latch_);
+template <typename K, typename V, size_t N>
+auto ExtendibleHashTable<K, V, N>::GetLocalDepth(int dir_index) const -> int {
   return GetLocalDepthInternal(dir_index);
 }
 
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetLocalDepthInternal(int dir_index) const -> int {
-  return dir_[dir_index]->GetDepth();
+template <typename K, typename V, size_t N>
+auto ExtendibleHashTable<K, V, N>::GetLocalDepthInternal(int dir_index) const -> int {
+  // acquire pairs with the release publish of a split, so the bucket read through the slot is at
+  // least as new as the pointer itself.
+  return dir_[dir_index].load(std::memory_order_acquire)->GetDepth();
 }
 
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetNumBuckets() const -> int {
-  std::scoped_lock<std::mutex> lock(latch_);
+template <typename K, typename V, size_t N>
+auto ExtendibleHashTable<K, V, N>::GetNumBuckets() const -> int {
   return GetNumBucketsInternal();
 }
 
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetNumBucketsInternal() const -> int {
-  return num_buckets_;
+template <typename K, typename V, size_t N>
+auto ExtendibleHashTable<K, V, N>::GetNumBucketsInternal() const -> int {
+  return num_buckets_.load(std::memory_order_relaxed);
 }
 
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Find(const K &key, V &value) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
-  return dir_[IndexOf(key)].get()->Find(key, value);
+template <typename K, typename V, size_t N>
+auto ExtendibleHashTable<K, V, N>::Find(const K &key, V &value) -> bool {
+  size_t hash = HashOf(key);  // hash once; the directory index and the fingerprint share it.
+  // latch-free read path: route through the atomic directory and validate the probe with the bucket's
+  // seqlock version. A torn read of the bucket arrays is harmless for trivially copyable types — the
+  // version check discards it — so other key/value types go straight to the latched path below.
+  if constexpr (std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>) {
+    for (int attempt = 0; attempt < kFindRetries; ++attempt) {
+      int gd = global_depth_.load(std::memory_order_acquire);
+      size_t index = hash & ((size_t{1} << gd) - 1);
+      Bucket *bucket = dir_[index].load(std::memory_order_acquire);
+      // the bucket is a dependent load off a possibly-cold directory slot: start pulling its key lines
+      // in while the version handshake below resolves.
+      __builtin_prefetch(bucket);
+      uint32_t version = bucket->ReadVersion();
+      if ((version & 1) != 0) {  // a mutation is in flight; try again.
+        continue;
+      }
+      bool found = bucket->Find(key, value, hash);
+      if (!bucket->ValidateRead(version)) {  // a mutation overlapped the probe; the result is garbage.
+        continue;
+      }
+      if (found) {
+        return true;
+      }
+      // a miss is only conclusive if the route is still current: a concurrent split may have moved the
+      // key to a sibling bucket after this thread picked its slot.
+      if (global_depth_.load(std::memory_order_acquire) == gd &&
+          dir_[index].load(std::memory_order_acquire) == bucket) {
+        return false;
+      }
+    }
+  }
+  std::scoped_lock<std::mutex> lock(latch_);  // stabilizes the route; the bucket latch excludes mutators.
+  Bucket *bucket = dir_[IndexFromHash(hash)].load(std::memory_order_relaxed);
+  std::scoped_lock<std::mutex> bucket_lock(bucket->Latch());
+  return bucket->Find(key, value, hash);
 }
 
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Remove(const K &key) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
-  for (auto &bucket : dir_) {
-    Bucket *l = bucket.get();
-    if (l->Remove(key)) {
-      return true;
+template <typename K, typename V, size_t N>
+auto ExtendibleHashTable<K, V, N>::Remove(const K &key) -> bool {
+  size_t hash = HashOf(key);  // pure computation: done before any latch to keep the critical sections tight.
+  // the key can only live in the bucket its hash routes to, and removing never splits, so the bucket's
+  // own latch suffices: removes from different buckets proceed in parallel. The route is revalidated
+  // after locking — a concurrent split may have republished the slot in between — and while the bucket
+  // latch is held a split of this bucket cannot start, so a validated route stays correct.
+  for (int attempt = 0; attempt < kFindRetries; ++attempt) {
+    int gd = global_depth_.load(std::memory_order_acquire);
+    size_t index = hash & ((size_t{1} << gd) - 1);
+    Bucket *bucket = dir_[index].load(std::memory_order_acquire);
+    __builtin_prefetch(bucket, 1);  // warm the slot arrays for writing while the latch is acquired.
+    std::scoped_lock<std::mutex> bucket_lock(bucket->Latch());
+    if (global_depth_.load(std::memory_order_acquire) == gd &&
+        dir_[index].load(std::memory_order_acquire) == bucket) {
+      return bucket->Remove(key);
     }
   }
-  return false;
+  std::scoped_lock<std::mutex> lock(latch_);  // fallback: the route cannot move under the table latch.
+  Bucket *bucket = dir_[IndexFromHash(hash)].load(std::memory_order_relaxed);
+  std::scoped_lock<std::mutex> bucket_lock(bucket->Latch());
+  return bucket->Remove(key);
 }
 
-template <typename K, typename V>
-void ExtendibleHashTable<K, V>::Insert(const K &key, const V &value) {
+template <typename K, typename V, size_t N>
+void ExtendibleHashTable<K, V, N>::Insert(const K &key, const V &value) {
+  size_t hash = HashOf(key);  // pure computation: done before any latch to keep the critical sections tight.
+  // fast path: an insert that does not split only needs the target bucket's latch, so inserts into
+  // different buckets proceed in parallel. The route is revalidated after locking, like in Remove.
+  for (int attempt = 0; attempt < kFindRetries; ++attempt) {
+    int gd = global_depth_.load(std::memory_order_acquire);
+    size_t index = hash & ((size_t{1} << gd) - 1);
+    Bucket *bucket = dir_[index].load(std::memory_order_acquire);
+    __builtin_prefetch(bucket, 1);  // warm the slot arrays for writing while the latch is acquired.
+    std::scoped_lock<std::mutex> bucket_lock(bucket->Latch());
+    if (global_depth_.load(std::memory_order_acquire) != gd ||
+        dir_[index].load(std::memory_order_acquire) != bucket) {
+      continue;  // the route moved underneath us; re-resolve it.
+    }
+    if (bucket->Insert(key, value, hash)) {
+      return;
+    }
+    break;  // the bucket is full: splitting needs the table latch.
+  }
   std::scoped_lock<std::mutex> lock(latch_);
-  Bucket *bucket = dir_[IndexOf(key)].get();
-  while (bucket->IsFull()) {                    // loop call Insert() untill the split bucket is not full.
-    int origin_index = IndexOf(key);            // original index of bucket.
-    if (bucket->GetDepth() == global_depth_) {  // expand the space of dir.
-      global_depth_++;                          // increment global depth.
-      size_t n = dir_.size();                   // original size.
-      dir_.resize(dir_.size() << 1, nullptr);   // double the size of
-      // initialize the hash index of expanded part of dir_.
-      int mask = (1 << (global_depth_ - 1)) - 1;  // get rid of the the largest bit of hash Index.
-      for (size_t i = n; i < dir_.size(); ++i) {
-        dir_[i] = dir_[i & mask];
+  while (true) {  // loop splitting untill the routed bucket accepts the pair.
+    Bucket *bucket = dir_[IndexFromHash(hash)].load(std::memory_order_relaxed);
+    {
+      // the table latch pins the route, but concurrent fast-path writers still mutate the bucket.
+      std::scoped_lock<std::mutex> bucket_lock(bucket->Latch());
+      if (bucket->Insert(key, value, hash)) {
+        return;
+      }
+    }
+    size_t origin_index = IndexFromHash(hash);  // original index of bucket.
+    int global_depth = global_depth_.load(std::memory_order_relaxed);
+    if (bucket->GetDepth() == global_depth) {  // expand the reachable prefix of dir.
+      BUSTUB_ASSERT(global_depth < max_global_depth_, "directory is already at its maximum depth.");
+      size_t n = size_t{1} << global_depth;  // reachable size before the depth increase.
+      // the upper half of the doubled prefix aliases the lower half (slot i maps to slot i - n): one
+      // slot copy into the preallocated storage, with no allocation and no nullptr-fill pass.
+      bool copied = false;
+#ifdef __AVX2__
+      if (n >= 4) {  // n is a power of two, so the byte count is an exact multiple of 32.
+        // the destination half is unreachable until the release store below publishes the new depth and
+        // all writers are excluded by the latch, so the copy can move 4 slots per 256-bit store instead
+        // of going through per-slot atomic operations.
+        static_assert(sizeof(std::atomic<Bucket *>) == sizeof(Bucket *), "atomic slot must be pointer-sized");
+        auto *src = reinterpret_cast<const __m256i *>(&dir_[0]);
+        auto *dst = reinterpret_cast<__m256i *>(&dir_[n]);
+        for (size_t i = 0; i < n / 4; ++i) {
+          _mm256_storeu_si256(dst + i, _mm256_loadu_si256(src + i));
+        }
+        copied = true;
+      }
+#endif
+      if (!copied) {
+        for (size_t i = 0; i < n; ++i) {
+          dir_[n + i].store(dir_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
       }
+      // release: the slot copies above become visible before any reader can observe the new depth.
+      global_depth_.store(global_depth + 1, std::memory_order_release);
     }
     // if global depth not eqaul to local depth, it does not need to expand dir_ space.
     bucket->IncrementDepth();  // increment local depth.
     // 3.create a new bucket.
-    std::shared_ptr<Bucket> new_bucket =
-        std::make_shared<Bucket>(bucket_size_, bucket->GetDepth());  // split. create new bucket.
-    num_buckets_++;                                                  // increase the numbers of buckets.
-    // 4. rearrange pointers.
-    size_t cur_mask = (1 << bucket->GetDepth()) - 1;
-    size_t pre_mask = cur_mask >> 1;
-    // size_t largest_bit = 1 << (bucket->GetDepth()-1);  // the largest bit of hash index.
-    std::shared_ptr<Bucket> splitted_bucket = dir_[origin_index];  // bookkeeping the splitted bucket.
-    for (size_t i = 0; i < dir_.size(); ++i) {
-      if ((pre_mask & i) == (pre_mask & origin_index) &&
-          ((cur_mask & i) >> (bucket->GetDepth() - 1) == 1)) {  // sibling
-        // if largest bit equals to 1, point to new sets.
-        dir_[i] = new_bucket;
-      }
+    pool_.push_back(std::make_unique<Bucket>(bucket_size_, bucket->GetDepth()));  // split. create new bucket.
+    Bucket *new_bucket = pool_.back().get();
+    num_buckets_.fetch_add(1, std::memory_order_relaxed);  // increase the numbers of buckets.
+    Bucket *splitted_bucket = dir_[origin_index].load(std::memory_order_relaxed);
+    // hold the splitted bucket's latch across all three phases: a fast-path writer appending or
+    // removing mid-redistribution would otherwise be missed by the partition mask.
+    std::scoped_lock<std::mutex> split_lock(splitted_bucket->Latch());
+    // 4./5. split in three phases so a latch-free reader never finds a key in neither bucket: copy the
+    // moving pairs into the still-unreachable new bucket, publish the sibling slots, and only then drop
+    // the moved pairs from the old bucket (that removal is covered by the old bucket's seqlock, and a
+    // reader holding the old route re-checks its slot on a miss).
+    size_t split_bit = size_t{1} << (bucket->GetDepth() - 1);  // the bit that tells the siblings apart.
+    // decide all slots at once: one vectorized pass over the stored hashes yields a bitmask of the
+    // slots that move, and both phases below just walk its set bits.
+    uint32_t moving = splitted_bucket->MatchMask(split_bit);
+    for (uint32_t m = moving; m != 0; m &= m - 1) {
+      auto i = static_cast<size_t>(__builtin_ctz(m));
+      new_bucket->Insert(splitted_bucket->KeyAt(i), splitted_bucket->ValueAt(i), splitted_bucket->HashAt(i));
+    }
+    // rearrange pointers. The slots that move to the new bucket agree with origin_index on the low
+    // depth-1 bits and have the new depth bit set: an arithmetic progression starting at
+    // (origin_index mod 2^(d-1)) | 2^(d-1) with stride 2^d, so walk exactly those slots — straight-line
+    // stores with no per-slot predicate over the whole directory.
+    size_t step = size_t{1} << bucket->GetDepth();
+    size_t dir_size = size_t{1} << global_depth_.load(std::memory_order_relaxed);
+    for (size_t i = (origin_index & (split_bit - 1)) | split_bit; i < dir_size; i += step) {
+      dir_[i].store(new_bucket, std::memory_order_release);  // publish the fully copied new bucket.
+    }
+    // drop the moved pairs highest slot first: every slot the swap-with-last removal pulls down has
+    // already been handled, so the recorded mask stays valid for the remaining lower slots.
+    while (moving != 0) {
+      auto i = static_cast<size_t>(31 - __builtin_clz(moving));
+      splitted_bucket->RemoveAt(i);
+      moving &= ~(uint32_t{1} << i);
     }
-    // 5.redistribute splitted bucket K, V pairs
-    RedistributeBucket(splitted_bucket, new_bucket);  // pass original bucket.
-
-    bucket = dir_[IndexOf(key)].get();
   }
-  bucket->Insert(key, value);  // updated.
 }
 
-template <typename K, typename V>
-void ExtendibleHashTable<K, V>::RedistributeBucket(std::shared_ptr<Bucket> bucket, std::shared_ptr<Bucket> new_bucket) {
-  auto &list = bucket->GetItems();
-  std::vector<std::pair<K, V>> del;  // elements will be deleted.
-  for (auto &elem : list) {
-    size_t dir_index = IndexOf(elem.first);
-    if (dir_[dir_index] == new_bucket) {  // rearrange pointer.
-      Bucket *b = new_bucket.get();
-      b->Insert(elem.first, elem.second);
-      del.push_back(elem);  // bookkeeping the elements will be deleted
+//===--------------------------------------------------------------------===//
+// Bucket
+//===--------------------------------------------------------------------===//
+template <typename K, typename V, size_t N>
+ExtendibleHashTable<K, V, N>::Bucket::Bucket(size_t array_size, int depth) : size_(array_size), depth_(depth) {
+  BUSTUB_ASSERT(array_size <= kMaxSlots, "bucket size exceeds the inline slot arrays.");
+}
+
+template <typename K, typename V, size_t N>
+auto ExtendibleHashTable<K, V, N>::Bucket::Find(const K &key, V &value) -> bool {
+  size_t n = count_;
+  size_t i = 0;
+#ifdef __AVX2__
+  // integral and pointer keys are compared 8 (32-bit) or 4 (64-bit) lanes at a time; the movemask
+  // pinpoints the matched lane with one tzcnt. Only whole chunks are probed this way, so no load runs
+  // past the end of the array and no padding sentinel is needed; the scalar loop below picks up the
+  // tail. Pointer equality is plain bit equality, so Page * keys take the 64-bit lane path too.
+  if constexpr (std::is_integral_v<K> && sizeof(K) == sizeof(int32_t)) {
+    const __m256i vkey = _mm256_set1_epi32(static_cast<int32_t>(key));
+    for (; i + 8 <= n; i += 8) {
+      __m256i vkeys = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&keys_[i]));
+      int m = _mm256_movemask_epi8(_mm256_cmpeq_epi32(vkey, vkeys));
+      if (m != 0) {
+        value = vals_[i + (static_cast<size_t>(__builtin_ctz(m)) >> 2)];
+        return true;
+      }
+    }
+  } else if constexpr ((std::is_integral_v<K> || std::is_pointer_v<K>) && sizeof(K) == sizeof(int64_t)) {
+    int64_t key_bits;
+    if constexpr (std::is_pointer_v<K>) {
+      key_bits = static_cast<int64_t>(reinterpret_cast<uintptr_t>(key));
+    } else {
+      key_bits = static_cast<int64_t>(key);
+    }
+    const __m256i vkey = _mm256_set1_epi64x(key_bits);
+    for (; i + 4 <= n; i += 4) {
+      __m256i vkeys = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&keys_[i]));
+      int m = _mm256_movemask_epi8(_mm256_cmpeq_epi64(vkey, vkeys));
+      if (m != 0) {
+        value = vals_[i + (static_cast<size_t>(__builtin_ctz(m)) >> 3)];
+        return true;
+      }
     }
   }
-  for (auto &e : del) {
-    list.remove(e);
+#endif
+  for (; i < n; ++i) {  // scan the contiguous key array; values stay untouched.
+    if (keys_[i] == key) {
+      value = vals_[i];  // store the V to value
+      return true;
+    }
   }
+  return false;
 }
 
-//===--------------------------------------------------------------------===//
-// Bucket
-//===--------------------------------------------------------------------===//
-template <typename K, typename V>
-ExtendibleHashTable<K, V>::Bucket::Bucket(size_t array_size, int depth) : size_(array_size), depth_(depth) {}
-
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::Find(const K &key, V &value) -> bool {
-  auto list = GetItems();
-  for (auto &c : list) {
-    if (c.first == key) {
-      value = c.second;  // store the V to value
+template <typename K, typename V, size_t N>
+auto ExtendibleHashTable<K, V, N>::Bucket::Find(const K &key, V &value, size_t hash) -> bool {
+#ifdef __SSE2__
+  // Swiss-table style probe: compare the sought fingerprint against all 16 control bytes at once and
+  // only run real key compares on the matching slots. Empty slots hold 0, which no fingerprint equals
+  // (H2 always has the top bit set), so a miss usually costs one compare and no key access at all.
+  const __m128i ctrl = _mm_load_si128(reinterpret_cast<const __m128i *>(ctrl_));
+  const __m128i match = _mm_set1_epi8(static_cast<char>(H2(hash)));
+  int m = _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, match));
+  while (m != 0) {
+    auto slot = static_cast<size_t>(__builtin_ctz(m));
+    if (keys_[slot] == key) {
+      value = vals_[slot];
       return true;
     }
+    m &= m - 1;  // clear the probed slot's bit; a colliding fingerprint falls through to the next one.
   }
   return false;
+#else
+  return Find(key, value);
+#endif
 }
 
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::Remove(const K &key) -> bool {
-  auto &list = GetItems();
-  int i = 0;
-  for (auto &c : list) {
-    i++;
-    if (c.first == key) {
-      list.remove(c);  // c++ 20 trait.
+template <typename K, typename V, size_t N>
+auto ExtendibleHashTable<K, V, N>::Bucket::MatchMask(size_t bit) const -> uint32_t {
+  uint32_t mask = 0;
+#ifdef __AVX2__
+  // test the bit in all 16 stored hashes with four AND + compare-to-zero rounds instead of 16 scalar
+  // test-and-branch iterations; slots past count_ hold stale hashes, masked off below.
+  static_assert(sizeof(size_t) == sizeof(int64_t), "hash lanes are assumed 64-bit");
+  const __m256i vbit = _mm256_set1_epi64x(static_cast<int64_t>(bit));
+  const __m256i zero = _mm256_setzero_si256();
+  for (size_t g = 0; g < kMaxSlots / 4; ++g) {
+    __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&hashes_[g * 4]));
+    // compare-equal-to-zero marks the lanes where the bit is clear; its complement is the match set.
+    int stays = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(h, vbit), zero)));
+    mask |= static_cast<uint32_t>(~stays & 0xF) << (g * 4);
+  }
+#else
+  for (size_t i = 0; i < count_; ++i) {
+    if ((hashes_[i] & bit) != 0) {
+      mask |= uint32_t{1} << i;
+    }
+  }
+#endif
+  return mask & ((uint32_t{1} << count_) - 1);
+}
+
+template <typename K, typename V, size_t N>
+void ExtendibleHashTable<K, V, N>::Bucket::RemoveAt(size_t slot) {
+  BeginWrite();
+  size_t last = count_ - 1;
+  keys_[slot] = std::move(keys_[last]);  // order within a bucket carries no meaning.
+  vals_[slot] = std::move(vals_[last]);
+  hashes_[slot] = hashes_[last];
+  ctrl_[slot] = ctrl_[last];  // the last slot's fingerprint moves with its pair.
+  ctrl_[last] = 0;
+  count_--;
+  EndWrite();
+}
+
+template <typename K, typename V, size_t N>
+auto ExtendibleHashTable<K, V, N>::Bucket::Remove(const K &key) -> bool {
+  for (size_t i = 0; i < count_; ++i) {
+    if (keys_[i] == key) {
+      RemoveAt(i);
       return true;
     }
   }
@@ -178,22 +374,26 @@ auto ExtendibleHashTable<K, V>::Bucket::Remove(const K &key) -> bool {
   return false;
 }
 
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::Insert(const K &key, const V &value) -> bool {
-  if (IsFull()) {  // bucket is full.
-    return false;
-  }
-  auto &list = GetItems();  // it should be use reference.
-  bool is_exist = false;
-  for (auto &c : list) {
-    if (c.first == key) {
-      c.second = value;  // if the key exist, update it.
-      is_exist = true;
+template <typename K, typename V, size_t N>
+auto ExtendibleHashTable<K, V, N>::Bucket::Insert(const K &key, const V &value, size_t hash) -> bool {
+  for (size_t i = 0; i < count_; ++i) {
+    if (keys_[i] == key) {
+      BeginWrite();
+      vals_[i] = value;  // if the key exist, update it.
+      EndWrite();
+      return true;
     }
   }
-  if (!is_exist) {
-    list.push_back({key, value});  // if the key does not exist, push the KV pair to bucket.
+  if (IsFull()) {  // bucket is full.
+    return false;
   }
+  BeginWrite();
+  ctrl_[count_] = H2(hash);  // record the fingerprint of the slot being filled.
+  keys_[count_] = key;       // if the key does not exist, append the pair to the arrays.
+  vals_[count_] = value;
+  hashes_[count_] = hash;
+  count_++;
+  EndWrite();
   return true;
 }
 
@@ -203,5 +403,6 @@ template class ExtendibleHashTable<int, int>;
 // test purpose
 template class ExtendibleHashTable<int, std::string>;
 template class ExtendibleHashTable<int, std::list<int>::iterator>;
+template class ExtendibleHashTable<int, int, 8>;
 
 }  // namespace bustub
@@ -12,14 +12,16 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <shared_mutex>        // NOLINT
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "buffer/lru_k_replacer.h"
 #include "common/config.h"
-#include "container/hash/extendible_hash_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -41,6 +43,21 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
                             LogManager *log_manager = nullptr);
 
+  /**
+   * @brief Creates a new BufferPoolManagerInstance that is one of several instances owned by a
+   * ParallelBufferPoolManager. Instance i only ever allocates page ids congruent to i modulo num_instances,
+   * so the instances never hand out conflicting ids without any shared allocation state.
+   * @param pool_size the size of this buffer pool instance
+   * @param num_instances total number of instances in the parallel buffer pool
+   * @param instance_index index of this instance in the parallel buffer pool
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                            LogManager *log_manager = nullptr);
+
   /**
    * @brief Destroy an existing BufferPoolManagerInstance.
    */
@@ -142,10 +159,12 @@ class BufferPoolManagerInstance : public BufferPoolManager {
 
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
-  /** The next page id to be allocated  */
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI). */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0). */
+  const uint32_t instance_index_ = 0;
+  /** The next page id to be allocated; strides by num_instances_. */
   std::atomic<page_id_t> next_page_id_ = 0;
-  /** Bucket size for the extendible hash table */
-  const size_t bucket_size_ = 4;
 
   /** Array of buffer pool pages. */
   Page *pages_;
@@ -153,14 +172,49 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  ExtendibleHashTable<page_id_t, frame_id_t> *page_table_;
+  /**
+   * Page table for keeping track of buffer pool pages: a dense array indexed by page id, with
+   * kFrameNotFound marking unmapped ids. Page ids come out of AllocatePage() monotonically, so the
+   * table stays compact and a lookup is a single load with no hashing, chasing or bucket latch.
+   * Lookups run under at least the shared latch; growth only happens under the exclusive latch.
+   */
+  std::atomic<frame_id_t> *page_table_;
+  /** Number of page-id slots allocated in page_table_. */
+  size_t page_table_capacity_;
+  /** Sentinel stored in page_table_ for page ids that are not resident. */
+  static constexpr frame_id_t kFrameNotFound = -1;
   /** Replacer to find unpinned pages for replacement. */
   LRUKReplacer *replacer_;
-  /** List of free frames that don't have any pages on them. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  /** Stack of free frames that don't have any pages on them; the top is the back. Reserved to
+   * pool_size_ up front, so pushes and pops never touch the allocator. */
+  std::vector<frame_id_t> free_list_;
+  /** Number of frames with a non-zero pin count, maintained on every 0 <-> 1 pin transition. When it
+   * equals pool_size_ there can be no free or evictable frame, so allocation paths fail with one load
+   * instead of consulting the free list and replacer. */
+  std::atomic<size_t> num_pinned_{0};
+
+  /** Per-frame IO state. A frame is kIoLoading from the moment a loader claims it under the exclusive
+   * latch until the victim write-back and/or page read against its buffer completes; the latch itself
+   * is NOT held across that IO. Loading frames are pinned, so they cannot be evicted meanwhile. */
+  std::atomic<uint8_t> *io_state_;
+  static constexpr uint8_t kIoReady = 0;
+  static constexpr uint8_t kIoLoading = 1;
+  /** Page ids whose dirty contents are being written back outside the latch. A fetch for one of these
+   * must wait for the write to finish or it could read the page's stale on-disk bytes. Guarded by the
+   * exclusive latch. */
+  std::unordered_set<page_id_t> flushing_;
+  /** Signals IO completions. io_epoch_ increments under cv_mutex_ on every completion, which lets
+   * waiters sample it before re-checking state and sleep without missing a wakeup. */
+  std::condition_variable cv_;
+  std::mutex cv_mutex_;
+  uint64_t io_epoch_{0};
+  /**
+   * Protects the page table, free list and page metadata. Paths that only pin an already-resident page
+   * (the FetchPgImp hit path) take it in shared mode: the pin count is atomic and the replacer carries
+   * its own latch, so concurrent hits do not serialize. Anything that can move a page between frames
+   * (miss, new, delete, flush) takes it exclusively.
+   */
+  std::shared_mutex latch_;
 
   /**
    * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
@@ -168,6 +222,46 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto AllocatePage() -> page_id_t;
 
+  /**
+   * @brief Look up the frame holding the given page. Caller must hold the latch in at least shared mode.
+   * @param page_id id of the page to look up
+   * @param[out] frame_id frame holding the page, if resident
+   * @return true if the page is resident in the buffer pool
+   */
+  auto FindFrame(page_id_t page_id, frame_id_t &frame_id) -> bool;
+
+  /**
+   * @brief Map a page id to a frame, growing the table if the id is past its capacity. Caller must hold
+   * the latch exclusively.
+   */
+  void InsertFrame(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * @brief Drop the mapping for a page id, if any. Caller must hold the latch exclusively.
+   */
+  void RemoveFrame(page_id_t page_id);
+
+  /**
+   * @brief Move a frame's mapping from one page id to another in a single remap: unmap old_page_id (if
+   * valid) and map new_page_id to the frame. This is what every replacement does, and doing it in one
+   * call means one bounds/growth check instead of two separate table operations. Caller must hold the
+   * latch exclusively.
+   */
+  void ReplaceFrame(page_id_t old_page_id, page_id_t new_page_id, frame_id_t frame_id);
+
+  /** @return the current IO completion epoch; pass it to WaitIoEpoch after re-checking state. */
+  auto CurrentIoEpoch() -> uint64_t;
+
+  /** @brief Sleep until some IO completes after the sampled epoch. Caller must not hold the latch. */
+  void WaitIoEpoch(uint64_t epoch);
+
+  /**
+   * @brief Mark a frame's out-of-latch IO as finished and wake all waiters.
+   * @param frame_id the frame whose IO completed
+   * @param flushed_page_id the page id whose write-back completed, or INVALID_PAGE_ID if none
+   */
+  void FinishIo(frame_id_t frame_id, page_id_t flushed_page_id);
+
   /**
    * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
    * @param page_id id of the page to deallocate
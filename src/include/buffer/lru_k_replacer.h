@@ -12,16 +12,16 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <climits>  // use INT_MAX
+#include <cstdint>
 #include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "common/config.h"
-#include "common/logger.h"
 #include "common/macros.h"
 
 #define INF INT_MAX
@@ -138,17 +138,84 @@ class LRUKReplacer {
   auto Size() -> size_t;
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  size_t current_timestamp_{0};
+  /**
+   * Intrusive doubly-linked list node shared by both eviction lists. The nodes live in the flat nodes_
+   * array indexed by frame id, so linking/unlinking is pure index arithmetic: no per-node heap
+   * allocation and no hash lookup to map a frame id to its list position. A frame has either < k or
+   * >= k recorded accesses, so it belongs to at most one list at a time and one node per frame suffices.
+   */
+  struct FrameNode {
+    frame_id_t prev;
+    frame_id_t next;
+    bool in_list{false};
+  };
+
+  /** Number of access records buffered before RecordAccess itself falls back to taking the latch. */
+  static constexpr size_t kPendingBatch = 16;
+  /** Marker for a pending slot that has been claimed but whose frame id is not yet visible. */
+  static constexpr frame_id_t kEmptySlot = -1;
+  /** Number of timestamps a thread reserves from the shared counter at a time. */
+  static constexpr size_t kTimestampBatch = 1024;
+
+  /** A buffered access record: the frame id doubles as the publish flag (kEmptySlot = not yet
+   * published), and the timestamp is stored before the id so the id's release makes it visible. */
+  struct PendingSlot {
+    std::atomic<size_t> ts{0};
+    std::atomic<frame_id_t> fid{kEmptySlot};
+  };
+
+  /** @return the timestamp for a new access, from the calling thread's reserved block. */
+  static auto NextTimestamp() -> size_t;
+
+  /**
+   * @brief Apply one access record with its pre-assigned timestamp. Caller must hold latch_.
+   */
+  void RecordAccessLocked(frame_id_t frame_id, size_t timestamp);
+
+  /**
+   * @brief Apply all buffered access records in FIFO order. Caller must hold latch_.
+   *
+   * Swaps the pending counter to its cap first so concurrent RecordAccess callers stop claiming slots
+   * and queue up on the latch instead, then replays the claimed slots and reopens the buffer.
+   */
+  void DrainPending();
+
+  /** @brief Insert the frame at the front (MRU end) of the history list. */
+  void LinkFront(frame_id_t frame_id);
+
+  /** @brief Remove the frame from the history list. */
+  void Unlink(frame_id_t frame_id);
+
+  /** @brief Recompute the frame's eviction scan key from its history and evictable flag. */
+  void UpdateScanKey(frame_id_t frame_id);
+
+  /** @return the timestamp of the k-th previous access of a frame with a full history ring. */
+  inline auto KthTimestamp(frame_id_t frame_id) -> size_t { return hist_[frame_id * k_ + hist_head_[frame_id]]; }
+
   size_t curr_size_{0};
   size_t replacer_size_;
   size_t k_;
   std::mutex latch_;
-  std::list<int> lru_1_replacer_;                           // <frame_id> store the frame which access times < k times.
-  std::vector<std::vector<int>> record_;                    // record the K nums of access history.
-  std::unordered_map<int, std::list<int>::iterator> hash_;  // store the frame which access history less than k.
-  std::vector<bool> is_evictable_;                          // store the evictable attribute of frames.
+  std::vector<FrameNode> nodes_;  // intrusive list of frames which access times < k, plus one sentinel.
+  frame_id_t sentinel_;           // index of the sentinel node in nodes_; LRU frame at the tail.
+  // Eviction candidates with >= k accesses live in one dense array of scan keys: the truncated
+  // k-th-last access timestamp when the frame is evictable, kIneligible otherwise. Evict takes the
+  // minimum in a single sequential sweep (16 frames per cache line), and keeping the key up to date on
+  // every transition makes RecordAccess O(1) instead of a sorted-list insert.
+  std::vector<uint32_t> scan_key_;
+  static constexpr uint32_t kIneligible = std::numeric_limits<uint32_t>::max();
+  // Access history as one flat array of k-slot ring buffers, indexed by frame_id * k_. Only the k-th
+  // previous timestamp is ever consulted, so older entries can be overwritten in place: recording an
+  // access is two array stores, with no per-frame heap vector and no unbounded growth.
+  std::vector<size_t> hist_;            // ring buffer slots: frame i owns hist_[i * k_, (i + 1) * k_).
+  std::vector<uint32_t> hist_head_;     // per-frame index of the next slot to overwrite (== oldest slot when full).
+  std::vector<uint32_t> hist_count_;    // per-frame number of recorded accesses, saturating at k.
+  std::vector<bool> is_evictable_;      // store the evictable attribute of frames.
+  // BP-Wrapper style access batching: RecordAccess claims a slot with one CAS and publishes the record
+  // there instead of taking latch_, so pool hits do not serialize on the replacer mutex. Every latched
+  // operation drains the buffer first, which keeps the observable record order exactly FIFO.
+  std::array<PendingSlot, kPendingBatch> pending_;
+  std::atomic<size_t> pending_size_{0};
 };
 
 }  // namespace bustub
@@ -17,9 +17,13 @@
 
 #pragma once
 
-#include <list>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -31,8 +35,10 @@ namespace bustub {
  * ExtendibleHashTable implements a hash table using the extendible hashing algorithm.
  * @tparam K key type
  * @tparam V value type
+ * @tparam N inline slot capacity of each bucket. A compile-time constant, so the probe loops have
+ * statically known bounds and a smaller capacity shrinks the per-bucket arrays.
  */
-template <typename K, typename V>
+template <typename K, typename V, size_t N = 16>
 class ExtendibleHashTable : public HashTable<K, V> {
  public:
   /**
@@ -41,8 +47,11 @@ class ExtendibleHashTable : public HashTable<K, V> {
    *
    * @brief Create a new ExtendibleHashTable.
    * @param bucket_size: fixed size for each bucket
+   * @param max_global_depth: upper bound on the global depth. The directory is preallocated to
+   * 1 << max_global_depth slots up front, so callers that know their table stays small can cap the
+   * reservation instead of paying for the default.
    */
-  explicit ExtendibleHashTable(size_t bucket_size);
+  explicit ExtendibleHashTable(size_t bucket_size, int max_global_depth = kMaxGlobalDepth);
 
   /**
    * @brief Get the global depth of the directory.
@@ -107,21 +116,63 @@ class ExtendibleHashTable : public HashTable<K, V> {
 
   /**
    * Bucket class for each hash table bucket that the directory points to.
+   * Keys and values live in two parallel vectors (reserved to the bucket capacity up front), so a key
+   * probe scans one small contiguous array without touching value payloads or chasing list nodes.
    */
-  class Bucket {
+  class alignas(64) Bucket {
    public:
+    /** Upper bound on slots per bucket: the compile-time capacity of the table's instantiation. */
+    static constexpr size_t kMaxSlots = N;
+    /** The control byte array is always one full 16-byte SSE register, whatever the slot capacity;
+     * bytes past kMaxSlots simply stay empty. */
+    static constexpr size_t kCtrlBytes = 16;
+    static_assert(N >= 4 && N <= kCtrlBytes && N % 4 == 0,
+                  "bucket capacity must fit the control bytes and fill whole SIMD groups");
+
     explicit Bucket(size_t size, int depth = 0);
 
     /** @brief Check if a bucket is full. */
-    inline auto IsFull() const -> bool { return list_.size() == size_; }
+    inline auto IsFull() const -> bool { return count_ == size_; }
 
     /** @brief Get the local depth of the bucket. */
-    inline auto GetDepth() const -> int { return depth_; }
+    inline auto GetDepth() const -> int { return depth_.load(std::memory_order_relaxed); }
+
+    /** @brief Increment the local depth of a bucket. Caller must hold the table latch. */
+    inline void IncrementDepth() { depth_.fetch_add(1, std::memory_order_relaxed); }
+
+    /** @brief Get the number of key-value pairs in the bucket. */
+    inline auto Size() const -> size_t { return count_; }
+
+    /** @brief Get the key stored at the given slot. */
+    inline auto KeyAt(size_t slot) const -> const K & { return keys_[slot]; }
+
+    /** @brief Get the value stored at the given slot. */
+    inline auto ValueAt(size_t slot) const -> const V & { return vals_[slot]; }
+
+    /** @brief Get the full hash of the key stored at the given slot. */
+    inline auto HashAt(size_t slot) const -> size_t { return hashes_[slot]; }
+
+    /** @brief Remove the pair at the given slot by swapping the last pair into its place. */
+    void RemoveAt(size_t slot);
 
-    /** @brief Increment the local depth of a bucket. */
-    inline void IncrementDepth() { depth_++; }
+    /**
+     * @brief Test the given hash bit for every occupied slot at once.
+     * @param bit A mask with the single hash bit to test (the split bit during redistribution).
+     * @return A bitmask with bit i set iff slot i is occupied and its stored hash has the bit set.
+     */
+    auto MatchMask(size_t bit) const -> uint32_t;
+
+    /** @return the bucket's latch. Covers every mutation of this bucket's slots. */
+    inline auto Latch() -> std::mutex & { return latch_; }
+
+    /** @return the bucket's version for a seqlock-style read; odd means a write is in progress. */
+    inline auto ReadVersion() const -> uint32_t { return version_.load(std::memory_order_acquire); }
 
-    inline auto GetItems() -> std::list<std::pair<K, V>> & { return list_; }
+    /** @return true if no write overlapped a read that began at the given (even) version. */
+    inline auto ValidateRead(uint32_t version) const -> bool {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return version_.load(std::memory_order_relaxed) == version;
+    }
 
     /**
      *
@@ -134,6 +185,16 @@ class ExtendibleHashTable : public HashTable<K, V> {
      */
     auto Find(const K &key, V &value) -> bool;
 
+    /**
+     * @brief Find with the key's hash already computed: probes the control bytes first, so slots whose
+     * fingerprint cannot match are rejected 16 at a time without ever comparing keys.
+     * @param key The key to be searched.
+     * @param[out] value The value associated with the key.
+     * @param hash The full hash of the key.
+     * @return True if the key is found, false otherwise.
+     */
+    auto Find(const K &key, V &value, size_t hash) -> bool;
+
     /**
      *
      * TODO(P1): Add implementation
@@ -153,35 +214,71 @@ class ExtendibleHashTable : public HashTable<K, V> {
      *      2. If the bucket is full, do nothing and return false.
      * @param key The key to be inserted.
      * @param value The value to be inserted.
+     * @param hash The full hash of the key, recorded as the slot's fingerprint.
      * @return True if the key-value pair is inserted, false otherwise.
      */
-    auto Insert(const K &key, const V &value) -> bool;
+    auto Insert(const K &key, const V &value, size_t hash) -> bool;
 
    private:
     // TODO(student): You may add additional private members and helper functions
+
+    /** @return the 7-bit fingerprint of a hash, with the top bit set so it never equals an empty slot. */
+    static inline auto H2(size_t hash) -> uint8_t { return static_cast<uint8_t>(hash >> 57) | 0x80; }
+
+    /** @brief Mark a mutation in progress (version becomes odd). Caller must hold the bucket's latch. */
+    inline void BeginWrite() { version_.fetch_add(1, std::memory_order_acq_rel); }
+
+    /** @brief Mark the mutation finished (version becomes even again). */
+    inline void EndWrite() { version_.fetch_add(1, std::memory_order_release); }
+
     size_t size_;
-    int depth_;
-    std::list<std::pair<K, V>> list_;
+    std::atomic<int> depth_;  // local depth; atomic so the depth accessor can read it without the latch.
+    // Inline fixed-capacity storage (kMaxSlots bounds size_): constructing a bucket performs no heap
+    // allocation at all, and inserts and removals are plain array stores.
+    std::array<K, kMaxSlots> keys_;
+    std::array<V, kMaxSlots> vals_;
+    // Full hash of each slot's key, so splits redistribute without re-hashing a single key.
+    std::array<size_t, kMaxSlots> hashes_;
+    uint8_t count_{0};  // number of occupied slots.
+    // One fingerprint byte per slot (0 = empty), kept in step with keys_ by Insert and RemoveAt.
+    // 16-byte aligned so the probe can load all of them with a single aligned SSE read.
+    alignas(16) uint8_t ctrl_[kCtrlBytes] = {};
+    // Seqlock version: mutators (latched) bump it odd before touching the arrays and even after, so a
+    // latch-free reader can detect that a probe overlapped a write and retry.
+    std::atomic<uint32_t> version_{0};
+    // Mutations of this bucket lock here, not the table latch, so writes to different buckets run in
+    // parallel; the table latch is only taken to split a bucket or grow the directory.
+    std::mutex latch_;
   };
 
  private:
   // TODO(student): You may add additional private members and helper functions and remove the ones
   // you don't need.
 
-  int global_depth_;    // The global depth of the directory
-  size_t bucket_size_;  // The size of a bucket
-  int num_buckets_;     // The number of buckets in the hash table
+  /** Default upper bound on the global depth. The directory is preallocated to the bound at
+   * construction, so growing is an O(reachable-prefix) slot copy with no allocation and no iterator
+   * invalidation. */
+  static constexpr int kMaxGlobalDepth = 16;
+  /** Latch-free Find attempts before falling back to the table latch. */
+  static constexpr int kFindRetries = 8;
+
+  std::atomic<int> global_depth_;  // The global depth of the directory; written under latch_.
+  int max_global_depth_;           // The depth the directory was preallocated for; global_depth_ never exceeds it.
+  size_t bucket_size_;             // The size of a bucket
+  std::atomic<int> num_buckets_;   // The number of buckets in the hash table; written under latch_.
+  // Serializes splits and directory growth (and backs the fallback read path). Plain inserts and
+  // removes take only their bucket's latch; lock order is always table latch before bucket latch.
   mutable std::mutex latch_;
-  std::vector<std::shared_ptr<Bucket>> dir_;  // The directory of the hash table
+  // The directory holds raw bucket pointers in atomic slots; the pool below owns the buckets and never
+  // shrinks (shrink & combination is out of scope). The array is sized to 1 << max_global_depth_ at
+  // construction and never moves, so a latch-free reader can load global_depth_ and then its slot
+  // without the storage shifting underneath it. Only the first 1 << global_depth_ slots are reachable;
+  // everything past them is stale until a depth increase rewrites it.
+  std::unique_ptr<std::atomic<Bucket *>[]> dir_;  // The directory of the hash table
+  std::vector<std::unique_ptr<Bucket>> pool_;     // Owns every bucket ever created.
 
   // The following functions are completely optional, you can delete them if you have your own ideas.
 
-  /**
-   * @brief Redistribute the kv pairs in a full bucket.
-   * @param bucket The bucket to be redistributed.
-   */
-  auto RedistributeBucket(std::shared_ptr<Bucket> bucket, std::shared_ptr<Bucket> new_bucket) -> void;
-
   /*****************************************************************
    * Must acquire latch_ first before calling the below functions. *
    *****************************************************************/
@@ -193,6 +290,23 @@ class ExtendibleHashTable : public HashTable<K, V> {
    */
   auto IndexOf(const K &key) -> size_t;
 
+  /** @return the full hash of a key. Hash each key once and pass the result around. */
+  static inline auto HashOf(const K &key) -> size_t {
+    if constexpr (std::is_pointer_v<K>) {
+      // std::hash of a pointer is the raw address, whose low bits are alignment-biased (always zero for
+      // Page *), so masking them for the directory index would leave most slots unused. One multiply by
+      // the golden-ratio constant diffuses the address bits across the whole word.
+      return reinterpret_cast<uintptr_t>(key) * size_t{0x9E3779B97F4A7C15};
+    } else {
+      return std::hash<K>()(key);
+    }
+  }
+
+  /** @return the directory index an already-computed hash falls into at the current global depth. */
+  inline auto IndexFromHash(size_t hash) const -> size_t {
+    return hash & ((size_t{1} << global_depth_.load(std::memory_order_relaxed)) - 1);
+  }
+
   auto GetGlobalDepthInternal() const -> int;
   auto GetLocalDepthInternal(int dir_index) const -> int;
   auto GetNumBucketsInternal() const -> int;
@@ -17,6 +17,8 @@
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 
@@ -58,6 +60,26 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Write a batch of pages to the database file. The default implementation issues one WritePage per
+   * entry; disk managers with an asynchronous backend can keep the whole batch in flight at once.
+   * @param pages pairs of page id and raw page data
+   */
+  virtual void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+    for (const auto &[page_id, page_data] : pages) {
+      WritePage(page_id, page_data);
+    }
+  }
+
+  /**
+   * Announce the memory region page IO will be served from, e.g. a buffer pool's page array. A no-op
+   * here; disk managers with a kernel-bypass backend can pin and register the region once so per-IO
+   * buffer mapping work disappears.
+   * @param buffer start of the region
+   * @param length length of the region in bytes
+   */
+  virtual void RegisterBuffer(void *buffer, size_t length) {}
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
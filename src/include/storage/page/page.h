@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -25,7 +26,7 @@ namespace bustub {
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
  */
-class Page {
+class alignas(64) Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
 
@@ -78,14 +79,22 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[BUSTUB_PAGE_SIZE]{};
+  // Layout: data_ comes first and spans exactly 64 cache lines, so the book-keeping fields below start
+  // on a fresh line, and the class-level alignas(64) pads the tail so they never share that line with
+  // the next Page either. Hot metadata operations (pin, unpin, dirty checks) therefore touch a single
+  // line per frame and cannot false-share with IO traffic on neighbouring frames' buffers.
+  static_assert(BUSTUB_PAGE_SIZE % 64 == 0, "page data must fill whole cache lines");
+
+  /** The actual data that is stored within a page. Cache-line aligned so page IO and SIMD/streaming
+   * routines can rely on the buffer's alignment. */
+  alignas(64) char data_[BUSTUB_PAGE_SIZE]{};
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
-  /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  /** The pin count of this page. Atomic so the buffer pool can pin resident pages under a shared latch. */
+  std::atomic<int> pin_count_{0};
+  /** True if the page is dirty, i.e. it is different from its corresponding page on disk. Atomic so the
+   * buffer pool can set it sticky on the unpin fast path without the exclusive latch. */
+  std::atomic<bool> is_dirty_{false};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
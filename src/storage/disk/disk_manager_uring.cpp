@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_uring.cpp
+//
+// Identification: src/storage/disk/disk_manager_uring.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_uring.h"
+
+#ifdef BUSTUB_HAS_LIBURING
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>  // NOLINT
+#endif
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+#ifndef BUSTUB_HAS_LIBURING
+
+// without liburing the class is just the synchronous DiskManager under another name.
+DiskManagerUring::DiskManagerUring(const std::string &db_file) : DiskManager(db_file) {}
+
+DiskManagerUring::~DiskManagerUring() = default;
+
+#else
+
+DiskManagerUring::DiskManagerUring(const std::string &db_file) : DiskManager(db_file) {
+  // the base constructor created the file if needed; reopen it as a raw fd for the ring.
+  fd_ = open(db_file.c_str(), O_RDWR);
+  if (fd_ < 0) {
+    throw Exception("can't open db file for io_uring");
+  }
+  if (io_uring_queue_init(kQueueDepth, &ring_, 0) < 0) {
+    close(fd_);
+    throw Exception("can't initialize io_uring queue");
+  }
+}
+
+DiskManagerUring::~DiskManagerUring() {
+  io_uring_queue_exit(&ring_);
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+void DiskManagerUring::RegisterBuffer(void *buffer, size_t length) {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  struct iovec iov;
+  iov.iov_base = buffer;
+  iov.iov_len = length;
+  if (io_uring_register_buffers(&ring_, &iov, 1) < 0) {
+    LOG_DEBUG("io_uring buffer registration failed; falling back to unregistered IO");
+    return;
+  }
+  registered_base_ = static_cast<const char *>(buffer);
+  registered_length_ = length;
+}
+
+void DiskManagerUring::PrepPageIo(struct io_uring_sqe *sqe, bool is_write, const char *page_data, size_t offset) {
+  if (InRegisteredBuffer(page_data)) {
+    // fixed-buffer opcodes reuse the pinning and mapping done once at registration time.
+    if (is_write) {
+      io_uring_prep_write_fixed(sqe, fd_, page_data, BUSTUB_PAGE_SIZE, offset, 0);
+    } else {
+      io_uring_prep_read_fixed(sqe, fd_, const_cast<char *>(page_data), BUSTUB_PAGE_SIZE, offset, 0);
+    }
+    return;
+  }
+  if (is_write) {
+    io_uring_prep_write(sqe, fd_, page_data, BUSTUB_PAGE_SIZE, offset);
+  } else {
+    io_uring_prep_read(sqe, fd_, const_cast<char *>(page_data), BUSTUB_PAGE_SIZE, offset);
+  }
+}
+
+auto DiskManagerUring::SubmitAndWait() -> int {
+  io_uring_submit(&ring_);
+  struct io_uring_cqe *cqe;
+  if (io_uring_wait_cqe(&ring_, &cqe) < 0) {
+    return -1;
+  }
+  int res = cqe->res;
+  io_uring_cqe_seen(&ring_, cqe);
+  return res;
+}
+
+void DiskManagerUring::WritePage(page_id_t page_id, const char *page_data) {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  num_writes_ += 1;
+  auto *sqe = io_uring_get_sqe(&ring_);
+  PrepPageIo(sqe, /*is_write=*/true, page_data, offset);
+  if (SubmitAndWait() != BUSTUB_PAGE_SIZE) {
+    LOG_DEBUG("I/O error while writing");
+    return;
+  }
+  // needs to flush to keep disk file in sync
+  sqe = io_uring_get_sqe(&ring_);
+  io_uring_prep_fsync(sqe, fd_, IORING_FSYNC_DATASYNC);
+  SubmitAndWait();
+}
+
+void DiskManagerUring::ReadPage(page_id_t page_id, char *page_data) {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  auto *sqe = io_uring_get_sqe(&ring_);
+  PrepPageIo(sqe, /*is_write=*/false, page_data, offset);
+  int read_count = SubmitAndWait();
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading");
+    return;
+  }
+  if (read_count < BUSTUB_PAGE_SIZE) {  // e.g. reading past the current end of file.
+    memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+  }
+}
+
+void DiskManagerUring::WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  size_t submitted = 0;
+  while (submitted < pages.size()) {
+    // fill the ring up to its depth, submit the wave with one enter, then reap all completions.
+    size_t batch = std::min<size_t>(pages.size() - submitted, kQueueDepth);
+    for (size_t i = 0; i < batch; ++i) {
+      const auto &[page_id, page_data] = pages[submitted + i];
+      auto *sqe = io_uring_get_sqe(&ring_);
+      PrepPageIo(sqe, /*is_write=*/true, page_data, static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE);
+      num_writes_ += 1;
+    }
+    io_uring_submit(&ring_);
+    for (size_t i = 0; i < batch; ++i) {
+      struct io_uring_cqe *cqe;
+      if (io_uring_wait_cqe(&ring_, &cqe) < 0) {
+        LOG_DEBUG("I/O error while writing");
+        return;
+      }
+      if (cqe->res != BUSTUB_PAGE_SIZE) {
+        LOG_DEBUG("I/O error while writing");
+      }
+      io_uring_cqe_seen(&ring_, cqe);
+    }
+    submitted += batch;
+  }
+  auto *sqe = io_uring_get_sqe(&ring_);
+  io_uring_prep_fsync(sqe, fd_, IORING_FSYNC_DATASYNC);
+  SubmitAndWait();
+}
+
+#endif  // BUSTUB_HAS_LIBURING
+
+}  // namespace bustub
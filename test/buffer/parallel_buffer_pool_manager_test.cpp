@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <cstdio>
+#include <string>
+#include <unordered_set>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t num_instances = 5;
+  const size_t buffer_pool_size = 10;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, k);
+
+  // Scenario: The pool size reported is the sum over all instances.
+  ASSERT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  // Scenario: We should be able to create new pages until we fill up every instance,
+  // and the strided allocators of the instances must never hand out the same id twice.
+  page_id_t page_id_temp;
+  std::unordered_set<page_id_t> allocated_ids;
+  for (size_t i = 0; i < num_instances * buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    ASSERT_TRUE(allocated_ids.insert(page_id_temp).second);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Page%d", page_id_temp);
+  }
+
+  // Scenario: Once every instance is full of pinned pages, creation fails.
+  ASSERT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Unpinning a page in one instance frees a frame only for ids routed to that instance.
+  for (page_id_t page_id : allocated_ids) {
+    ASSERT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: We should be able to fetch back the data we wrote through the owning instances.
+  for (page_id_t page_id : allocated_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "Page%d", page_id);
+    ASSERT_EQ(0, strcmp(page->GetData(), expected));
+    ASSERT_EQ(true, bpm->UnpinPage(page_id, false));
+    ASSERT_EQ(true, bpm->DeletePage(page_id));
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
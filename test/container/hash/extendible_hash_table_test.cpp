@@ -79,6 +79,23 @@ TEST(ExtendibleHashTableTest, SampleTest) {
   EXPECT_EQ(5, table->GetNumBuckets());
 }
 
+TEST(ExtendibleHashTableTest, CustomCapacityTest) {
+  // a table instantiated with a smaller compile-time slot capacity behaves the same.
+  auto table = std::make_unique<ExtendibleHashTable<int, int, 8>>(8);
+
+  for (int i = 0; i < 64; i++) {
+    table->Insert(i, i * 2);
+  }
+  for (int i = 0; i < 64; i++) {
+    int val;
+    EXPECT_TRUE(table->Find(i, val));
+    EXPECT_EQ(i * 2, val);
+  }
+  EXPECT_TRUE(table->Remove(0));
+  int val;
+  EXPECT_FALSE(table->Find(0, val));
+}
+
 TEST(ExtendibleHashTableTest, ConcurrentInsertTest) {
   const int num_runs = 50;
   const int num_threads = 3;